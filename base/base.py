@@ -99,6 +99,8 @@ def switchToRadioControl():
 def requestTelemetryDump():
     """
     requestTelemetryDump prompts the buggy for its telemtry data.
+    The answer contains the control mode (0x00: base, 0x01: radio, 0x02: lost),
+    followed for each on-board command source by its id and its accepted, rate-limited, preempted, invalid and overridden commands counters (32 bits little-endian).
     """
     sendRawBytes(bytearray((0x00, 0xaa, 0xba, 0xff)))
 
@@ -0,0 +1,111 @@
+#include "../source/arbitration.hpp"
+
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+/// Sources configurations (priority, rate, burst, lease).
+const auto sourcesConfigurations = std::map<uint8_t, SourceConfiguration>{
+    {0, {0, 50, 10, std::chrono::milliseconds(0)}}, // planner
+    {1, {1, 100, 10, std::chrono::milliseconds(200)}}, // reflex
+    {2, {1, 100, 10, std::chrono::milliseconds(200)}}, // second reflex, same priority
+};
+const auto defaultSourceConfiguration = SourceConfiguration{0, 20, 5, std::chrono::milliseconds(0)};
+
+int main() {
+    auto failed = false;
+    auto check = [&](bool condition, const std::string& description) {
+        std::cout << (condition ? "passed: " : "failed: ") << description << "\n";
+        failed = failed || !condition;
+    };
+    const auto start = std::chrono::steady_clock::now();
+
+    // rate limit
+    {
+        Arbitration<4> arbitration(sourcesConfigurations, defaultSourceConfiguration);
+        std::size_t accepted = 0;
+        for (std::size_t index = 0; index < 100; ++index) {
+            accepted += arbitration.arbitrate(0, 1, start);
+        }
+        check(accepted == 10, "a source is rate-limited after burst commands");
+        check(arbitration.arbitrate(0, 2, start), "the rate limit applies to each channel separately");
+        check(!arbitration.arbitrate(0, 1, start + std::chrono::milliseconds(10)), "a bucket holds no token before 1 / rate");
+        check(arbitration.arbitrate(0, 1, start + std::chrono::milliseconds(40)), "a bucket refills at rate");
+        const auto counters = arbitration.counters().at(0);
+        check(counters.accepted == 12 && counters.rateLimited == 91, "rate-limited commands are counted");
+    }
+
+    // default configuration
+    {
+        Arbitration<4> arbitration(sourcesConfigurations, defaultSourceConfiguration);
+        std::size_t accepted = 0;
+        for (std::size_t index = 0; index < 100; ++index) {
+            accepted += arbitration.arbitrate(42, 1, start);
+        }
+        check(accepted == 5, "an unknown source uses the default burst");
+        check(arbitration.arbitrate(1, 2, start) && !arbitration.arbitrate(43, 2, start), "an unknown source has the default priority");
+        check(!arbitration.arbitrate(42, 4, start) && arbitration.counters().at(42).invalid == 1, "out-of-range channels are counted as invalid");
+    }
+
+    // priority and lease
+    {
+        Arbitration<4> arbitration(sourcesConfigurations, defaultSourceConfiguration);
+        check(arbitration.arbitrate(0, 1, start), "a free channel accepts a low-priority source");
+        check(arbitration.arbitrate(1, 1, start + std::chrono::milliseconds(10)), "a higher-priority source takes over a channel");
+        check(!arbitration.arbitrate(0, 1, start + std::chrono::milliseconds(100)), "a lease blocks lower-priority sources");
+        check(arbitration.arbitrate(0, 2, start + std::chrono::milliseconds(100)), "a lease only blocks its channel");
+        check(arbitration.arbitrate(1, 1, start + std::chrono::milliseconds(150)), "the lease owner keeps writing");
+        check(!arbitration.arbitrate(0, 1, start + std::chrono::milliseconds(300)), "an accepted command renews the lease");
+        check(arbitration.arbitrate(0, 1, start + std::chrono::milliseconds(350)), "an expired lease frees the channel");
+        check(arbitration.counters().at(0).preempted == 2, "preempted commands are counted");
+    }
+
+    // equal priorities
+    {
+        Arbitration<4> arbitration(sourcesConfigurations, defaultSourceConfiguration);
+        check(arbitration.arbitrate(1, 1, start), "the first source of equal priority leases the channel");
+        check(!arbitration.arbitrate(2, 1, start + std::chrono::milliseconds(100)), "an equal-priority source cannot take over a lease");
+        check(arbitration.arbitrate(2, 1, start + std::chrono::milliseconds(200)), "an equal-priority source writes once the lease expired");
+        check(!arbitration.arbitrate(1, 1, start + std::chrono::milliseconds(300)), "the new owner holds the lease");
+    }
+
+    // commands read together
+    for (auto reflexFirst : {true, false}) {
+        Arbitration<4> arbitration(sourcesConfigurations, defaultSourceConfiguration);
+        const auto planner = Command{0, 1, 1600};
+        const auto reflex = Command{1, 1, 1400};
+        const auto indicesAndValues = arbitration.arbitrate(
+            reflexFirst ? std::vector<Command>{reflex, planner} : std::vector<Command>{planner, reflex},
+            start
+        );
+        const auto order = std::string(reflexFirst ? " (higher priority first)" : " (higher priority last)");
+        check(indicesAndValues[1].first && indicesAndValues[1].second == 1400, "the higher priority wins a read" + order);
+        check(!indicesAndValues[0].first && !indicesAndValues[2].first && !indicesAndValues[3].first, "channels without commands are left unchanged" + order);
+        const auto counters = arbitration.counters();
+        check(counters.at(1).accepted == 1 && counters.at(0).accepted == 0, "only the winner is accepted" + order);
+        check(counters.at(0).overridden == 1 && counters.at(0).preempted == 0, "the loser is counted as overridden" + order);
+        std::size_t accepted = 0;
+        for (std::size_t index = 0; index < 20; ++index) {
+            accepted += arbitration.arbitrate(0, 1, start + std::chrono::milliseconds(300));
+        }
+        check(accepted == 10, "an overridden command does not use a token" + order);
+    }
+    {
+        Arbitration<4> arbitration(sourcesConfigurations, defaultSourceConfiguration);
+        const auto indicesAndValues = arbitration.arbitrate(std::vector<Command>{{0, 1, 1600}, {0, 1, 1650}, {42, 1, 1700}}, start);
+        check(indicesAndValues[1].first && indicesAndValues[1].second == 1700, "the last command wins a read among equal priorities");
+        check(arbitration.counters().at(0).overridden == 2, "every overridden command is counted");
+    }
+    {
+        Arbitration<4> arbitration(sourcesConfigurations, defaultSourceConfiguration);
+        for (std::size_t index = 0; index < 10; ++index) {
+            arbitration.arbitrate(0, 1, start);
+        }
+        const auto indicesAndValues = arbitration.arbitrate(std::vector<Command>{{42, 1, 1700}, {0, 1, 1600}}, start + std::chrono::milliseconds(1));
+        check(indicesAndValues[1].first && indicesAndValues[1].second == 1700, "a rate-limited winner leaves the channel to the next candidate");
+        check(arbitration.counters().at(0).rateLimited == 1, "the rate-limited winner is counted");
+    }
+
+    std::cout.flush();
+    return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
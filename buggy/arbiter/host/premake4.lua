@@ -0,0 +1,31 @@
+solution 'arbitration'
+    configurations {'Release', 'Debug'}
+    location 'build'
+
+    project 'arbitration'
+
+        -- General settings
+        kind 'ConsoleApp'
+        language 'C++'
+        location 'build'
+        files {'**.cpp', '../source/arbitration.hpp'}
+
+        -- Declare the configurations
+        configuration 'Release'
+            targetdir 'build/Release'
+            defines {'NDEBUG'}
+            flags {'OptimizeSpeed'}
+        configuration 'Debug'
+            targetdir 'build/Debug'
+            defines {'DEBUG'}
+            flags {'Symbols'}
+
+        -- Linux specific settings
+        configuration 'linux'
+            buildoptions {'-std=c++11'}
+            linkoptions {'-std=c++11'}
+
+        -- Mac OS X specific settings
+        configuration 'macosx'
+            buildoptions {'-std=c++11', '-stdlib=libc++'}
+            linkoptions {'-std=c++11', '-stdlib=libc++'}
@@ -1,6 +1,8 @@
 #include "eventLoop.hpp"
 #include "tty.hpp"
 #include "log.hpp"
+#include "arbitration.hpp"
+#include "control.hpp"
 
 #include <sys/un.h>
 #include <sys/stat.h>
@@ -8,25 +10,22 @@
 #include <chrono>
 #include <vector>
 #include <array>
+#include <map>
+#include <iterator>
 #include <mutex>
 #include <condition_variable>
 #include <iostream>
 #include <sstream>
 
-/// Control determines which remote is controlling the buggy.
-enum class Control {
-    base, // the radio module driven by the developper to implement custom behavior
-    radio, // the original buggy controller, required as a security (the buggy will stop if the controller is not switched on)
-    lost, // connection with the radio controller lost, stops the buggy until the connection is back
+/// sourcesConfigurations defines the priority, rate limit and lease of the known on-board command sources.
+/// Scripts declare their source with buggy.setSource: the identifiers listed here are reserved.
+const auto sourcesConfigurations = std::map<uint8_t, SourceConfiguration>{
+    {0, {0, 50, 10, std::chrono::milliseconds(0)}}, // path planner
+    {1, {1, 100, 10, std::chrono::milliseconds(200)}}, // obstacle-avoidance reflex
 };
 
-/// motorsZeros defines the neutral command for each motor.
-const auto motorsZeros = std::array<uint16_t, 4>{
-    1500, // direction
-    1552, // throttle
-    1500, // pan
-    1500, // tilt
-};
+/// defaultSourceConfiguration is used for sources missing from sourcesConfigurations (each one still has its own rate limits).
+const auto defaultSourceConfiguration = SourceConfiguration{0, 20, 5, std::chrono::milliseconds(0)};
 
 /// logFile is used for debug.
 const auto logFilename = std::string("/home/nuc/rotifera/buggy/arbiter/arbiter.log");
@@ -55,6 +54,8 @@ int main() {
             std::vector<std::pair<uint8_t, uint16_t>> bufferedIndicesAndValues;
             std::mutex indicesAndValuesLock;
             std::condition_variable indicesAndValuesChanged;
+            Arbitration<motorsZeros.size()> arbitration(sourcesConfigurations, defaultSourceConfiguration);
+            std::mutex arbitrationLock;
             std::vector<int32_t> sockets;
             std::mutex socketsLock;
 
@@ -108,10 +109,7 @@ int main() {
             eventLoops.push_back(make_eventLoop([&](std::atomic_bool& running) {
                 auto previousBytes = std::array<uint8_t, 2>{};
                 uint8_t expectedByteId = 0;
-                std::size_t badCounter = 0;
-                std::size_t onlyOnesCounter = 0;
-                std::size_t goodCounter = 0;
-                auto preemptCounters = std::array<uint64_t, motorsZeros.size()>{0, 0};
+                RadioMonitor<motorsZeros.size()> radioMonitor(control, motorsZeros);
                 while (running.load(std::memory_order_relaxed)) {
                     try {
                         const auto byte = arduino.read();
@@ -127,79 +125,17 @@ int main() {
                                 throw std::logic_error("the arduino sent an out-of-range index");
                             }
                             const uint16_t value = static_cast<uint16_t>(previousBytes[1] >> 2) | (static_cast<uint16_t>(byte & 0xfc) << 4);
-                            switch (control.load(std::memory_order_acquire)) {
-                                case Control::base: {
-                                    if (value < 800 || value > 2200) {
-                                        ++badCounter;
-                                        if (badCounter > 10) {
-                                            throw std::runtime_error("bad values");
-                                        }
-                                    } else if (std::abs(value - motorsZeros[index]) > 100) {
-                                        ++preemptCounters[index];
-                                        if (preemptCounters[index] > 10) {
-                                            control.store(Control::radio, std::memory_order_release);
-                                        }
-                                    } else {
-                                        preemptCounters[index] = 0;
-                                        if (index == 0) {
-                                            onlyOnesCounter = 0;
-                                        } else {
-                                            ++onlyOnesCounter;
-                                            if (onlyOnesCounter > 10) {
-                                                throw std::runtime_error("only ones");
-                                            }
-                                        }
-                                    }
-                                    break;
-                                }
-                                case Control::radio: {
-                                    for (auto& preemptCounter : preemptCounters) {
-                                        preemptCounter = 0;
-                                    }
-                                    if (value < 800 || value > 2200) {
-                                        ++badCounter;
-                                        if (badCounter > 10) {
-                                            throw std::runtime_error("bad values");
-                                        }
-                                    } else {
-                                        if (index == 0) {
-                                            onlyOnesCounter = 0;
-                                        } else {
-                                            ++onlyOnesCounter;
-                                            if (onlyOnesCounter > 10) {
-                                                throw std::runtime_error("only ones");
-                                            }
-                                        }
-                                        {
-                                            std::lock_guard<std::mutex> lockGuard(indicesAndValuesLock);
-                                            indicesAndValues.emplace_back(index, value);
-                                        }
-                                        indicesAndValuesChanged.notify_one();
-                                    }
-                                    break;
-                                }
-                                case Control::lost: {
-                                    if (value > 800 && value < 2200) {
-                                        ++goodCounter;
-                                        if (goodCounter > 10) {
-                                            goodCounter = 0;
-                                            control.store(Control::radio, std::memory_order_release);
-                                        }
-                                    } else {
-                                        goodCounter = 0;
-                                    }
-                                    break;
+                            if (radioMonitor.handle(index, value, std::chrono::steady_clock::now())) {
+                                {
+                                    std::lock_guard<std::mutex> lockGuard(indicesAndValuesLock);
+                                    indicesAndValues.emplace_back(index, value);
                                 }
+                                indicesAndValuesChanged.notify_one();
                             }
                         }
                     } catch (const std::runtime_error& exception) {
                         log.write(std::string("radio controller exception: ") + exception.what());
-                        badCounter = 0;
-                        goodCounter = 0;
-                        for (auto& preemptCounter : preemptCounters) {
-                            preemptCounter = 0;
-                        }
-                        control.store(Control::lost, std::memory_order_release);
+                        radioMonitor.lose();
                         {
                             std::lock_guard<std::mutex> lockGuard(indicesAndValuesLock);
                             indicesAndValues.clear();
@@ -270,6 +206,29 @@ int main() {
                                                         }
                                                     }
 
+                                                    // append the arbitration counters (source id, then 32 bits little-endian counters)
+                                                    auto sourcesIdsAndCounters = std::map<uint8_t, SourceCounters>{};
+                                                    {
+                                                        std::lock_guard<std::mutex> lockGuard(arbitrationLock);
+                                                        sourcesIdsAndCounters = arbitration.counters();
+                                                    }
+                                                    std::stringstream logMessage;
+                                                    logMessage << "Arbitration counters (accepted, rate-limited, preempted, invalid, overridden):";
+                                                    for (const auto& sourceIdAndCounters : sourcesIdsAndCounters) {
+                                                        const auto& counters = sourceIdAndCounters.second;
+                                                        message.push_back(sourceIdAndCounters.first);
+                                                        for (auto counter : {counters.accepted, counters.rateLimited, counters.preempted, counters.invalid, counters.overridden}) {
+                                                            for (uint8_t shift = 0; shift < 32; shift += 8) {
+                                                                message.push_back(static_cast<uint8_t>((counter >> shift) & 0xff));
+                                                            }
+                                                        }
+                                                        logMessage
+                                                            << " " << +sourceIdAndCounters.first << ": {"
+                                                            << counters.accepted << ", " << counters.rateLimited << ", "
+                                                            << counters.preempted << ", " << counters.invalid << ", " << counters.overridden << "}";
+                                                    }
+                                                    log.write(logMessage.str());
+
                                                     // encode and send the message
                                                     auto bytes = std::vector<uint8_t>{0x00};
                                                     for (auto byte : message) {
@@ -469,7 +428,8 @@ int main() {
                 if (fileDescriptor < 0) {
                     throw std::logic_error(std::string("opening the fifo '") + fifoName + "' failed");
                 }
-                auto bytes = std::array<uint8_t, 3>{};
+                auto bytes = std::array<uint8_t, 256>{};
+                auto commands = std::vector<Command>{};
                 fd_set fileDescriptorsSet;
                 timespec timeout;
                 timeout.tv_sec = 1;
@@ -481,29 +441,57 @@ int main() {
                         throw std::logic_error(std::string("select with fifo '") + fifoName + "' failed");
                     }
                     if (FD_ISSET(fileDescriptor, &fileDescriptorsSet)) {
+
+                        // records are written atomically, hence the buffer size (a multiple of 4) yields complete records
+                        //        | Byte 0 | Byte 1 | Byte 2    | Byte 3
+                        // -------|--------|--------|-----------|-----------
+                        // Record | source | index  | value LSB | value MSB
                         const auto bytesRead = read(fileDescriptor, bytes.data(), bytes.size());
                         if (bytesRead < 0) {
                             throw std::logic_error(std::string("reading from the fifo '") + fifoName + "' failed");
                         }
-                        if (bytesRead == bytes.size()) {
+                        if (bytesRead % 4 != 0) {
+                            throw std::logic_error(std::string("reading from the fifo '") + fifoName + "' yielded an unexpected number of bytes");
+                        }
+                        if (bytesRead > 0 && control.load(std::memory_order_acquire) == Control::base) {
+
+                            // forward at most one command per channel
+                            commands.clear();
+                            for (auto recordIterator = bytes.begin(); recordIterator != std::next(bytes.begin(), bytesRead); std::advance(recordIterator, 4)) {
+                                commands.push_back(Command{
+                                    recordIterator[0],
+                                    recordIterator[1],
+                                    static_cast<uint16_t>((static_cast<uint16_t>(recordIterator[3]) << 8) | static_cast<uint16_t>(recordIterator[2])),
+                                });
+                            }
+                            auto winners = std::array<std::pair<bool, uint16_t>, motorsZeros.size()>{};
+                            {
+                                const auto now = std::chrono::steady_clock::now();
+                                std::lock_guard<std::mutex> lockGuard(arbitrationLock);
+                                winners = arbitration.arbitrate(commands, now);
+                            }
+                            auto commandsChanged = false;
                             {
                                 std::lock_guard<std::mutex> lockGuard(indicesAndValuesLock);
-                                {
-                                    std::stringstream logMessage;
-                                    logMessage << "Message received from local script: {";
-                                    for (std::size_t index = 0; index < bytes.size() - 1; ++index) {
-                                        logMessage << +bytes[index] << ", ";
+                                for (uint8_t index = 0; index < winners.size(); ++index) {
+                                    if (winners[index].first) {
+                                        indicesAndValues.emplace_back(index, winners[index].second);
+                                        commandsChanged = true;
                                     }
-                                    logMessage << +bytes[bytes.size() - 1] << "}";
-                                    log.write(logMessage.str());
-                                }
-                                if (control.load(std::memory_order_release) == Control::base) {
-                                    indicesAndValues.emplace_back(bytes[0], (static_cast<uint16_t>(bytes[2]) << 8) | static_cast<uint16_t>(bytes[1]));
                                 }
                             }
-                            indicesAndValuesChanged.notify_one();
-                        } else if (bytesRead > 0) {
-                            throw std::logic_error(std::string("reading from the fifo '") + fifoName + "' yielded an unexpected number of bytes");
+                            if (commandsChanged) {
+                                indicesAndValuesChanged.notify_one();
+                            }
+                        }
+                        if (bytesRead > 0) {
+                            std::stringstream logMessage;
+                            logMessage << "Messages received from local scripts: {";
+                            for (ssize_t index = 0; index < bytesRead - 1; ++index) {
+                                logMessage << +bytes[index] << ", ";
+                            }
+                            logMessage << +bytes[bytesRead - 1] << "}";
+                            log.write(logMessage.str());
                         }
                     }
                 }
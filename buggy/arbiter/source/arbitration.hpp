@@ -0,0 +1,192 @@
+#pragma once
+
+#include <array>
+#include <map>
+#include <vector>
+#include <chrono>
+#include <cstdint>
+#include <algorithm>
+#include <utility>
+
+/// SourceConfiguration defines how commands from an on-board process are arbitrated.
+/// Without a lease, priorities only resolve the commands read together from the fifo:
+/// a later command from a lower-priority source overrides an earlier one.
+struct SourceConfiguration {
+    uint8_t priority; // a source can take over a channel leased by a source with a lower priority
+    double rate; // sustained number of accepted commands per second, for each channel
+    double burst; // number of commands which can be accepted at once, for each channel
+    std::chrono::milliseconds lease; // duration a channel stays reserved after an accepted command, 0 disables the reservation
+};
+
+/// SourceCounters keeps track of the arbitration decisions for a source.
+/// The counters are sent as 32 bits integers in the telemetry dump.
+struct SourceCounters {
+    uint32_t accepted;
+    uint32_t rateLimited; // dropped because the source exceeded its rate
+    uint32_t preempted; // dropped because the channel is leased by a source with a higher or equal priority
+    uint32_t invalid; // dropped because the channel does not exist
+    uint32_t overridden; // dropped because a command read at the same time won the channel
+};
+
+/// Command is a record read from the fifo.
+struct Command {
+    uint8_t source;
+    uint8_t index;
+    uint16_t value;
+};
+
+/// Arbitration resolves conflicting commands sent by several sources.
+template <std::size_t channelsCount>
+class Arbitration {
+    public:
+        Arbitration(
+            const std::map<uint8_t, SourceConfiguration>& sourcesConfigurations,
+            const SourceConfiguration& defaultSourceConfiguration
+        ) :
+            _sourcesConfigurations(sourcesConfigurations),
+            _defaultSourceConfiguration(defaultSourceConfiguration)
+        {
+            for (auto& channel : _channels) {
+                channel.leased = false;
+                channel.owner = 0;
+                channel.priority = 0;
+            }
+        }
+        Arbitration(const Arbitration&) = delete;
+        Arbitration(Arbitration&&) = default;
+        Arbitration& operator=(const Arbitration&) = delete;
+        Arbitration& operator=(Arbitration&&) = default;
+        virtual ~Arbitration() {}
+
+        /// arbitrate resolves commands read together, and returns for each channel whether a command won it and its value.
+        /// Commands blocked by a lease are preempted. Among the others, the highest priority wins (the last command on ties).
+        /// Only the winner uses a token: if its source is rate-limited, the next candidate is considered.
+        virtual std::array<std::pair<bool, uint16_t>, channelsCount> arbitrate(
+            const std::vector<Command>& commands,
+            std::chrono::steady_clock::time_point now
+        ) {
+            auto indicesAndValues = std::array<std::pair<bool, uint16_t>, channelsCount>{};
+            auto candidates = std::array<std::vector<std::size_t>, channelsCount>{};
+            for (std::size_t position = 0; position < commands.size(); ++position) {
+                const auto& command = commands[position];
+                auto& source = sourceFromId(command.source, now);
+                if (command.index >= channelsCount) {
+                    ++source.counters.invalid;
+                    continue;
+                }
+                const auto& channel = _channels[command.index];
+                if (
+                    channel.leased
+                    && channel.owner != command.source
+                    && now < channel.leaseEnd
+                    && channel.priority >= source.configuration.priority
+                ) {
+                    ++source.counters.preempted;
+                    continue;
+                }
+                candidates[command.index].push_back(position);
+            }
+            for (std::size_t index = 0; index < channelsCount; ++index) {
+                std::sort(candidates[index].begin(), candidates[index].end(), [&](std::size_t first, std::size_t second) {
+                    const auto firstPriority = _sources.at(commands[first].source).configuration.priority;
+                    const auto secondPriority = _sources.at(commands[second].source).configuration.priority;
+                    return firstPriority == secondPriority ? first > second : firstPriority > secondPriority;
+                });
+                for (auto position : candidates[index]) {
+                    const auto& command = commands[position];
+                    auto& source = _sources.at(command.source);
+                    if (indicesAndValues[index].first) {
+                        ++source.counters.overridden;
+                        continue;
+                    }
+                    auto& bucket = source.buckets[index];
+                    bucket.tokens = std::min(
+                        source.configuration.burst,
+                        bucket.tokens + source.configuration.rate * std::chrono::duration<double>(now - bucket.lastRefill).count()
+                    );
+                    bucket.lastRefill = now;
+                    if (bucket.tokens < 1) {
+                        ++source.counters.rateLimited;
+                        continue;
+                    }
+                    bucket.tokens -= 1;
+                    auto& channel = _channels[index];
+                    channel.leased = true;
+                    channel.owner = command.source;
+                    channel.priority = source.configuration.priority;
+                    channel.leaseEnd = now + source.configuration.lease;
+                    ++source.counters.accepted;
+                    indicesAndValues[index] = std::make_pair(true, command.value);
+                }
+            }
+            return indicesAndValues;
+        }
+
+        /// arbitrate resolves a single command, and returns true if it must be forwarded to the motors.
+        virtual bool arbitrate(uint8_t sourceId, uint8_t index, std::chrono::steady_clock::time_point now) {
+            const auto indicesAndValues = arbitrate(std::vector<Command>{Command{sourceId, index, 0}}, now);
+            return index < channelsCount && indicesAndValues[index].first;
+        }
+
+        /// counters returns the decisions counters of each source seen so far, sorted by source id.
+        virtual std::map<uint8_t, SourceCounters> counters() const {
+            auto sourcesIdsAndCounters = std::map<uint8_t, SourceCounters>{};
+            for (const auto& sourceIdAndSource : _sources) {
+                sourcesIdsAndCounters.emplace(sourceIdAndSource.first, sourceIdAndSource.second.counters);
+            }
+            return sourcesIdsAndCounters;
+        }
+
+    protected:
+
+        /// Bucket is a token bucket limiting the commands rate of a source on a channel.
+        struct Bucket {
+            double tokens;
+            std::chrono::steady_clock::time_point lastRefill;
+        };
+
+        /// Source holds the state of a command source.
+        struct Source {
+            SourceConfiguration configuration;
+            std::array<Bucket, channelsCount> buckets;
+            SourceCounters counters;
+        };
+
+        /// Channel holds the lease of a motor channel.
+        struct Channel {
+            bool leased;
+            uint8_t owner;
+            uint8_t priority;
+            std::chrono::steady_clock::time_point leaseEnd;
+        };
+
+        /// sourceConfiguration returns the configuration of a source, or the default one if the source is unknown.
+        virtual const SourceConfiguration& sourceConfiguration(uint8_t sourceId) const {
+            const auto sourceConfigurationIterator = _sourcesConfigurations.find(sourceId);
+            if (sourceConfigurationIterator == _sourcesConfigurations.end()) {
+                return _defaultSourceConfiguration;
+            }
+            return sourceConfigurationIterator->second;
+        }
+
+        /// sourceFromId returns the state of a source, and creates it on first use.
+        virtual Source& sourceFromId(uint8_t sourceId, std::chrono::steady_clock::time_point now) {
+            auto sourceIterator = _sources.find(sourceId);
+            if (sourceIterator == _sources.end()) {
+                auto source = Source{};
+                source.configuration = sourceConfiguration(sourceId);
+                for (auto& bucket : source.buckets) {
+                    bucket.tokens = source.configuration.burst;
+                    bucket.lastRefill = now;
+                }
+                source.counters = SourceCounters{0, 0, 0, 0, 0};
+                sourceIterator = _sources.emplace(sourceId, source).first;
+            }
+            return sourceIterator->second;
+        }
+
+        const std::map<uint8_t, SourceConfiguration> _sourcesConfigurations;
+        const SourceConfiguration _defaultSourceConfiguration;
+        std::map<uint8_t, Source> _sources;
+        std::array<Channel, channelsCount> _channels;
+};
@@ -0,0 +1,151 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <stdexcept>
+
+/// Control determines which remote is controlling the buggy.
+enum class Control {
+    base, // the radio module driven by the developper to implement custom behavior
+    radio, // the original buggy controller, required as a security (the buggy will stop if the controller is not switched on)
+    lost, // connection with the radio controller lost, stops the buggy until the connection is back
+};
+
+/// motorsZeros defines the neutral command for each motor.
+const auto motorsZeros = std::array<uint16_t, 4>{
+    1500, // direction
+    1552, // throttle
+    1500, // pan
+    1500, // tilt
+};
+
+/// radioMinimum and radioMaximum bound the valid radio pulse widths (in microseconds).
+const uint16_t radioMinimum = 800;
+const uint16_t radioMaximum = 2200;
+
+/// radioDeflection is the distance to zero above which a radio sample is a stick deflection (in microseconds).
+/// The arduino sends every deflected or out-of-range sample, hence the checks on such samples count them.
+const uint16_t radioDeflection = 100;
+
+/// radioSamplesThreshold is the number of consecutive deflected samples (respectively bad samples)
+/// above which the radio takes over (respectively the connection is considered lost).
+const std::size_t radioSamplesThreshold = 10;
+
+/// The arduino sends samples close to zero only once per refresh period, hence the checks on such samples are timed.
+/// radioOnlyOnesTimeout is the maximum duration without direction samples while throttle samples are received.
+/// radioRecoveryDuration is the duration of valid samples, including a direction one, required to leave the lost state.
+const auto radioOnlyOnesTimeout = std::chrono::milliseconds(220);
+const auto radioRecoveryDuration = std::chrono::milliseconds(110);
+
+/// RadioMonitor hands the buggy control over between the base and the radio controller, from the samples relayed by the arduino.
+template <std::size_t channelsCount>
+class RadioMonitor {
+    public:
+        RadioMonitor(std::atomic<Control>& control, const std::array<uint16_t, channelsCount>& zeros) :
+            _control(control),
+            _zeros(zeros),
+            _started(false),
+            _badCounter(0),
+            _recovering(false)
+        {
+            _preemptCounters.fill(0);
+        }
+        RadioMonitor(const RadioMonitor&) = delete;
+        RadioMonitor(RadioMonitor&&) = default;
+        RadioMonitor& operator=(const RadioMonitor&) = delete;
+        RadioMonitor& operator=(RadioMonitor&&) = default;
+        virtual ~RadioMonitor() {}
+
+        /// handle processes a radio sample, and returns true if it must be forwarded to the motors.
+        /// A std::runtime_error is thrown if the sample shows that the radio controller is lost.
+        virtual bool handle(uint8_t index, uint16_t value, std::chrono::steady_clock::time_point now) {
+            if (!_started) {
+                _started = true;
+                _lastDirection = now;
+            }
+            switch (_control.load(std::memory_order_acquire)) {
+                case Control::base: {
+                    if (value < radioMinimum || value > radioMaximum) {
+                        countBadValue();
+                    } else {
+                        checkDirection(index, now);
+                        if (std::abs(static_cast<int32_t>(value) - static_cast<int32_t>(_zeros[index])) > radioDeflection) {
+                            ++_preemptCounters[index];
+                            if (_preemptCounters[index] > radioSamplesThreshold) {
+                                _control.store(Control::radio, std::memory_order_release);
+                            }
+                        } else {
+                            _preemptCounters[index] = 0;
+                        }
+                    }
+                    return false;
+                }
+                case Control::radio: {
+                    _preemptCounters.fill(0);
+                    if (value < radioMinimum || value > radioMaximum) {
+                        countBadValue();
+                        return false;
+                    }
+                    checkDirection(index, now);
+                    return true;
+                }
+                case Control::lost: {
+                    if (value > radioMinimum && value < radioMaximum) {
+                        if (index == 0) {
+                            _lastDirection = now;
+                        }
+                        if (!_recovering) {
+                            _recovering = true;
+                            _recoveryStart = now;
+                        } else if (now - _recoveryStart >= radioRecoveryDuration && _lastDirection >= _recoveryStart) {
+                            _recovering = false;
+                            _control.store(Control::radio, std::memory_order_release);
+                        }
+                    } else {
+                        _recovering = false;
+                    }
+                    return false;
+                }
+            }
+            return false;
+        }
+
+        /// lose resets the counters and switches to the lost state.
+        virtual void lose() {
+            _badCounter = 0;
+            _recovering = false;
+            _preemptCounters.fill(0);
+            _control.store(Control::lost, std::memory_order_release);
+        }
+
+    protected:
+
+        /// countBadValue throws once too many out-of-range samples were received.
+        virtual void countBadValue() {
+            ++_badCounter;
+            if (_badCounter > radioSamplesThreshold) {
+                throw std::runtime_error("bad values");
+            }
+        }
+
+        /// checkDirection throws if throttle samples keep coming without direction samples.
+        virtual void checkDirection(uint8_t index, std::chrono::steady_clock::time_point now) {
+            if (index == 0) {
+                _lastDirection = now;
+            } else if (now - _lastDirection > radioOnlyOnesTimeout) {
+                throw std::runtime_error("only ones");
+            }
+        }
+
+        std::atomic<Control>& _control;
+        const std::array<uint16_t, channelsCount> _zeros;
+        bool _started;
+        std::size_t _badCounter;
+        std::array<std::size_t, channelsCount> _preemptCounters;
+        std::chrono::steady_clock::time_point _lastDirection;
+        bool _recovering;
+        std::chrono::steady_clock::time_point _recoveryStart;
+};
@@ -0,0 +1,18 @@
+#pragma once
+
+#include "firmware.hpp"
+
+/// inputConfigurations declares the radio inputs (direction, throttle).
+/// The zeros must match the arbiter's motorsZeros, and the tolerances must not exceed its radioDeflection.
+const InputConfiguration inputConfigurations[] = {
+    {1500, 100, 4, 50}, // direction
+    {1552, 100, 4, 50}, // throttle
+};
+
+/// outputConfigurations declares the motors (direction, throttle, pan, tilt).
+const OutputConfiguration outputConfigurations[] = {
+    {1500, 0}, // direction
+    {1552, 1000}, // throttle
+    {1500, 0}, // pan
+    {1500, 0}, // tilt
+};
@@ -0,0 +1,213 @@
+#pragma once
+
+#include <stdint.h>
+
+/// InputConfiguration controls how a radio channel is reported to the arbiter.
+struct InputConfiguration {
+    uint16_t zero; // neutral pulse width (in microseconds)
+    uint16_t tolerance; // samples further than this from zero are always sent, so the arbiter's consecutive-samples checks keep their timing (in microseconds)
+    uint16_t deadband; // a sample is sent only if it differs from the last sent one by more than this value (in microseconds)
+    uint16_t refreshPeriod; // maximum duration between two sent samples regardless of changes (in milliseconds), 0 sends every sample
+};
+
+/// OutputConfiguration holds a motor channel's neutral command and failsafe.
+struct OutputConfiguration {
+    uint16_t zero; // neutral command (in microseconds)
+    uint16_t failsafeTimeout; // duration without incoming bytes before the channel is set to zero (in milliseconds), 0 disables the failsafe
+};
+
+/// Statistics counts the serial traffic and the decisions taken by the firmware.
+struct Statistics {
+    uint32_t bytesRead;
+    uint32_t bytesWritten;
+    uint32_t samplesSent;
+    uint32_t samplesSuppressed;
+    uint32_t commandsApplied;
+    uint32_t framesDiscarded;
+    uint32_t failsafes;
+};
+
+/// Firmware implements the protocol and scheduling logic independently from the board.
+/// Hal must provide:
+///     uint32_t micros();
+///     uint32_t millis();
+///     bool available();
+///     uint8_t read();
+///     void write(const uint8_t* bytes, uint8_t size);
+///     void writeMicroseconds(uint8_t index, uint16_t value);
+///     void disableInterrupts();
+///     void enableInterrupts();
+template <typename Hal, uint8_t inputsCount, uint8_t outputsCount>
+class Firmware {
+    public:
+        Firmware(
+            Hal& hal,
+            const InputConfiguration (&inputConfigurations)[inputsCount],
+            const OutputConfiguration (&outputConfigurations)[outputsCount]
+        ) :
+            _hal(hal),
+            _expectedByteId(0),
+            _lastRead(0),
+            _statistics{0, 0, 0, 0, 0, 0, 0}
+        {
+            for (uint8_t index = 0; index < inputsCount; ++index) {
+                _inputs[index].configuration = inputConfigurations[index];
+                _inputs[index].value = 0;
+                _inputs[index].hasNewMeasure = false;
+                _inputs[index].isCounting = false;
+                _inputs[index].start = 0;
+                _inputs[index].hasSent = false;
+                _inputs[index].lastSentValue = 0;
+                _inputs[index].lastSentTime = 0;
+            }
+            for (uint8_t index = 0; index < outputsCount; ++index) {
+                _outputs[index].configuration = outputConfigurations[index];
+                _outputs[index].failsafeEngaged = false;
+            }
+            _previousBytes[0] = 0;
+            _previousBytes[1] = 0;
+        }
+        Firmware(const Firmware&) = delete;
+        Firmware(Firmware&&) = default;
+        Firmware& operator=(const Firmware&) = delete;
+        Firmware& operator=(Firmware&&) = default;
+        virtual ~Firmware() {}
+
+        /// setup sets every output to its neutral command.
+        virtual void setup() {
+            for (uint8_t index = 0; index < outputsCount; ++index) {
+                _hal.writeMicroseconds(index, _outputs[index].configuration.zero);
+            }
+            _lastRead = _hal.millis();
+        }
+
+        /// edge must be called from the interrupt attached to an input whenever its pwm signal changes.
+        virtual void edge(uint8_t index, bool high) {
+            Input& input = _inputs[index];
+            if (high) {
+                input.start = _hal.micros();
+                input.isCounting = true;
+            } else if (input.isCounting) {
+                input.value = static_cast<uint16_t>(_hal.micros() - input.start);
+                input.isCounting = false;
+                input.hasNewMeasure = true;
+            }
+        }
+
+        /// loop sends the pending samples, drains the incoming bytes and applies the failsafes.
+        virtual void loop() {
+            for (uint8_t index = 0; index < inputsCount; ++index) {
+                Input& input = _inputs[index];
+                _hal.disableInterrupts();
+                const bool hasNewMeasure = input.hasNewMeasure;
+                const uint16_t value = input.value;
+                input.hasNewMeasure = false;
+                _hal.enableInterrupts();
+                if (hasNewMeasure) {
+                    const uint32_t now = _hal.millis();
+                    const uint16_t change = value > input.lastSentValue ? value - input.lastSentValue : input.lastSentValue - value;
+                    const uint16_t deviation = value > input.configuration.zero ? value - input.configuration.zero : input.configuration.zero - value;
+                    if (
+                        !input.hasSent
+                        || deviation > input.configuration.tolerance
+                        || change > input.configuration.deadband
+                        || now - input.lastSentTime >= input.configuration.refreshPeriod
+                    ) {
+                        input.hasSent = true;
+                        input.lastSentValue = value;
+                        input.lastSentTime = now;
+
+                        //             | LSB  | bit 1 | bit 2 | bit 3 | bit 4 | bit 5 | bit 6 | MSB
+                        // ------------|------|-------|-------|-------|-------|-------|-------|-------
+                        // First byte  | 0    | 0     | i[0]  | i[1]  | i[2]  | i[3]  | i[4]  | i[5]
+                        // Second byte | 1    | 0     | v[0]  | v[1]  | v[2]  | v[3]  | v[4]  | v[5]
+                        // Third byte  | 0    | 1     | v[6]  | v[7]  | v[8]  | v[9]  | v[10] | v[11]
+                        const uint8_t bytes[3] = {
+                            static_cast<uint8_t>(0 | (index << 2)),
+                            static_cast<uint8_t>(1 | (value << 2)),
+                            static_cast<uint8_t>(2 | ((value >> 4) & 0xfc)),
+                        };
+                        _hal.write(bytes, 3);
+                        _statistics.bytesWritten += 3;
+                        ++_statistics.samplesSent;
+                    } else {
+                        ++_statistics.samplesSuppressed;
+                    }
+                }
+            }
+
+            if (_hal.available()) {
+                do {
+                    handleByte(_hal.read());
+                } while (_hal.available());
+                _lastRead = _hal.millis();
+                for (uint8_t index = 0; index < outputsCount; ++index) {
+                    _outputs[index].failsafeEngaged = false;
+                }
+            } else {
+                const uint32_t elapsed = _hal.millis() - _lastRead;
+                for (uint8_t index = 0; index < outputsCount; ++index) {
+                    Output& output = _outputs[index];
+                    if (output.configuration.failsafeTimeout > 0 && !output.failsafeEngaged && elapsed > output.configuration.failsafeTimeout) {
+                        _hal.writeMicroseconds(index, output.configuration.zero);
+                        output.failsafeEngaged = true;
+                        ++_statistics.failsafes;
+                    }
+                }
+            }
+        }
+
+        /// statistics returns the counters accumulated since the firmware was created.
+        virtual const Statistics& statistics() const {
+            return _statistics;
+        }
+
+    protected:
+
+        /// Input represents a pwm signal read on an interrupt pin.
+        struct Input {
+            InputConfiguration configuration;
+            volatile uint16_t value;
+            volatile bool hasNewMeasure;
+            volatile bool isCounting;
+            volatile uint32_t start;
+            bool hasSent;
+            uint16_t lastSentValue;
+            uint32_t lastSentTime;
+        };
+
+        /// Output represents a motor channel.
+        struct Output {
+            OutputConfiguration configuration;
+            bool failsafeEngaged;
+        };
+
+        /// handleByte runs the read state machine.
+        virtual void handleByte(uint8_t byte) {
+            ++_statistics.bytesRead;
+            if ((byte & 0x3) != _expectedByteId) {
+                if (_expectedByteId > 0) {
+                    ++_statistics.framesDiscarded;
+                }
+                _expectedByteId = 0;
+            } else if (_expectedByteId < 2) {
+                _previousBytes[_expectedByteId] = byte;
+                ++_expectedByteId;
+            } else {
+                _expectedByteId = 0;
+                const uint8_t index = (_previousBytes[0] >> 2);
+                if (index < outputsCount) {
+                    _hal.writeMicroseconds(index, static_cast<uint16_t>(_previousBytes[1] >> 2) | (static_cast<uint16_t>(byte & 0xfc) << 4));
+                    ++_statistics.commandsApplied;
+                }
+            }
+        }
+
+        Hal& _hal;
+        Input _inputs[inputsCount];
+        Output _outputs[outputsCount];
+        uint8_t _previousBytes[2];
+        uint8_t _expectedByteId;
+        uint32_t _lastRead;
+        Statistics _statistics;
+};
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+/// HostHal emulates the board with a simulated clock, so that the firmware can run on a computer.
+class HostHal {
+    public:
+
+        /// Command represents a pulse width applied to an output.
+        struct Command {
+            uint64_t timestamp; // time at which the command was applied (in microseconds)
+            uint8_t index;
+            uint16_t value;
+        };
+
+        HostHal() :
+            _now(0)
+        {
+        }
+        HostHal(const HostHal&) = delete;
+        HostHal(HostHal&&) = default;
+        HostHal& operator=(const HostHal&) = delete;
+        HostHal& operator=(HostHal&&) = default;
+        virtual ~HostHal() {}
+
+        /// now returns the simulated time (in microseconds).
+        virtual uint64_t now() const {
+            return _now;
+        }
+
+        /// advance moves the simulated clock forward.
+        virtual void advance(uint64_t duration) {
+            _now += duration;
+        }
+
+        /// receive adds a byte to the serial input buffer.
+        virtual void receive(uint8_t byte) {
+            _received.push_back(byte);
+        }
+
+        /// sent returns the bytes written to the serial port.
+        virtual const std::vector<uint8_t>& sent() const {
+            return _sent;
+        }
+
+        /// commands returns the pulse widths applied to the outputs.
+        virtual const std::vector<Command>& commands() const {
+            return _commands;
+        }
+
+        uint32_t micros() {
+            return static_cast<uint32_t>(_now);
+        }
+        uint32_t millis() {
+            return static_cast<uint32_t>(_now / 1000);
+        }
+        bool available() {
+            return !_received.empty();
+        }
+        uint8_t read() {
+            const auto byte = _received.front();
+            _received.pop_front();
+            return byte;
+        }
+        void write(const uint8_t* bytes, uint8_t size) {
+            _sent.insert(_sent.end(), bytes, bytes + size);
+        }
+        void writeMicroseconds(uint8_t index, uint16_t value) {
+            _commands.push_back(Command{_now, index, value});
+        }
+        void disableInterrupts() {}
+        void enableInterrupts() {}
+
+    protected:
+        uint64_t _now;
+        std::deque<uint8_t> _received;
+        std::vector<uint8_t> _sent;
+        std::vector<Command> _commands;
+};
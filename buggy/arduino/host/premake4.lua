@@ -0,0 +1,31 @@
+solution 'simulator'
+    configurations {'Release', 'Debug'}
+    location 'build'
+
+    project 'simulator'
+
+        -- General settings
+        kind 'ConsoleApp'
+        language 'C++'
+        location 'build'
+        files {'**.hpp', '**.cpp', '../firmware.hpp', '../configuration.hpp', '../../arbiter/source/control.hpp'}
+
+        -- Declare the configurations
+        configuration 'Release'
+            targetdir 'build/Release'
+            defines {'NDEBUG'}
+            flags {'OptimizeSpeed'}
+        configuration 'Debug'
+            targetdir 'build/Debug'
+            defines {'DEBUG'}
+            flags {'Symbols'}
+
+        -- Linux specific settings
+        configuration 'linux'
+            buildoptions {'-std=c++11'}
+            linkoptions {'-std=c++11'}
+
+        -- Mac OS X specific settings
+        configuration 'macosx'
+            buildoptions {'-std=c++11', '-stdlib=libc++'}
+            linkoptions {'-std=c++11', '-stdlib=libc++'}
@@ -0,0 +1,225 @@
+#include "hal.hpp"
+#include "../firmware.hpp"
+#include "../configuration.hpp"
+#include "../../arbiter/source/control.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+/// Event represents a stimulus applied to the simulated board.
+struct Event {
+    enum class Type {
+        rising, // the pwm signal of the input goes high
+        falling, // the pwm signal of the input goes low
+        byte, // a byte is received on the serial port
+    };
+    uint64_t timestamp;
+    Type type;
+    uint8_t payload;
+};
+
+/// Simulation parameters (durations in microseconds).
+const uint64_t duration = 10000000;
+const uint64_t step = 4;
+const uint64_t loopPeriod = 100; // duration of a loop iteration on the board
+const uint64_t radioPeriod = 20000;
+const uint64_t throttleOffset = 2500;
+const uint64_t commandPeriod = 10012; // not a multiple of loopPeriod, so that commands arrive at every phase of the loop
+const uint64_t bytePeriod = 44; // 10 bits at 230400 bauds
+const uint64_t commandsEnd = 8000000;
+const uint64_t linkCapacity = 23040; // bytes per second at 230400 bauds
+const uint64_t maximumLatencyBound = 2 * bytePeriod + loopPeriod; // the frame's last byte is handled by the next loop iteration
+const uint64_t maximumSamplesSent = 560; // about 510 samples are expected, versus 975 without change suppression
+
+/// Radio scenario (durations in microseconds).
+const uint64_t directionLostStart = 1000000; // no direction pulses until directionLostEnd
+const uint64_t directionLostEnd = 1500000;
+const uint64_t throttleBadStart = 2500000; // out-of-range throttle pulses until throttleBadEnd
+const uint64_t throttleBadEnd = 3000000;
+const uint64_t baseControlStart = 3500000; // the base takes control back
+const uint64_t throttleDeflectionStart = 5000000; // the throttle stick is held deflected from then on
+
+/// Transition represents a change of the arbiter's control state.
+struct Transition {
+    uint64_t timestamp;
+    Control control;
+};
+
+/// expectedTransitions lists the control changes caused by the radio scenario, with the latest time each may happen.
+/// Without change suppression, the arbiter reacts after about 220 ms to faults and deflections, and recovers after about 110 ms.
+const Transition expectedTransitions[][2] = {
+    {{directionLostStart, Control::lost}, {directionLostStart + 300000, Control::lost}}, // only ones
+    {{directionLostEnd, Control::radio}, {directionLostEnd + 160000, Control::radio}}, // recovery
+    {{throttleBadStart, Control::lost}, {throttleBadStart + 240000, Control::lost}}, // bad values
+    {{throttleBadEnd, Control::radio}, {throttleBadEnd + 160000, Control::radio}}, // recovery
+    {{throttleDeflectionStart, Control::radio}, {throttleDeflectionStart + 240000, Control::radio}}, // radio takeover
+};
+
+/// throttleAt returns the radio throttle pulse width.
+uint16_t throttleAt(uint64_t timestamp) {
+    if (timestamp >= throttleBadStart && timestamp < throttleBadEnd) {
+        return 2500;
+    }
+    if (timestamp >= throttleDeflectionStart) {
+        return 1700;
+    }
+    return 1552;
+}
+
+int main() {
+
+    // the firmware and the arbiter are built separately, hence their shared values are checked here
+    for (std::size_t index = 0; index < sizeof(inputConfigurations) / sizeof(InputConfiguration); ++index) {
+        if (inputConfigurations[index].zero != motorsZeros[index] || inputConfigurations[index].tolerance > radioDeflection) {
+            std::cerr << "the input " << index << " configuration does not match the arbiter" << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+    for (std::size_t index = 0; index < sizeof(outputConfigurations) / sizeof(OutputConfiguration); ++index) {
+        if (outputConfigurations[index].zero != motorsZeros[index]) {
+            std::cerr << "the output " << index << " configuration does not match the arbiter" << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+
+    auto events = std::vector<Event>{};
+    auto framesStarts = std::vector<uint64_t>{};
+    {
+        uint32_t seed = 1;
+        auto jitter = [&]() {
+            seed = seed * 1103515245 + 12345;
+            return static_cast<int32_t>((seed >> 16) % 5) - 2;
+        };
+        for (uint64_t timestamp = 0; timestamp < duration; timestamp += radioPeriod) {
+            const auto direction = static_cast<uint64_t>(1500 + jitter());
+            const auto throttle = static_cast<uint64_t>(throttleAt(timestamp) + jitter());
+            if (timestamp < directionLostStart || timestamp >= directionLostEnd) {
+                events.push_back(Event{timestamp, Event::Type::rising, 0});
+                events.push_back(Event{timestamp + direction, Event::Type::falling, 0});
+            }
+            events.push_back(Event{timestamp + throttleOffset, Event::Type::rising, 1});
+            events.push_back(Event{timestamp + throttleOffset + throttle, Event::Type::falling, 1});
+        }
+        // each command sends two back-to-back frames
+        for (uint64_t timestamp = 0; timestamp < commandsEnd; timestamp += commandPeriod) {
+            auto byteTimestamp = timestamp;
+            for (uint8_t index = 0; index < 2; ++index) {
+                framesStarts.push_back(byteTimestamp);
+                const uint16_t value = outputConfigurations[index].zero + static_cast<uint16_t>((timestamp / commandPeriod) % 50);
+                for (auto byte : {
+                    static_cast<uint8_t>(0b00 | (index << 2)),
+                    static_cast<uint8_t>(0b01 | (value << 2)),
+                    static_cast<uint8_t>(0b10 | ((value >> 4) & 0xfc)),
+                }) {
+                    events.push_back(Event{byteTimestamp, Event::Type::byte, byte});
+                    byteTimestamp += bytePeriod;
+                }
+            }
+        }
+        std::stable_sort(events.begin(), events.end(), [](const Event& first, const Event& second) {
+            return first.timestamp < second.timestamp;
+        });
+    }
+
+    HostHal hal;
+    Firmware<HostHal, 2, 4> firmware(hal, inputConfigurations, outputConfigurations);
+    firmware.setup();
+    auto eventIterator = events.begin();
+
+    // run the arbiter's radio monitor on the samples sent upstream
+    std::size_t decodedBytes = 0;
+    std::atomic<Control> control{Control::base};
+    RadioMonitor<motorsZeros.size()> radioMonitor(control, motorsZeros);
+    auto transitions = std::vector<Transition>{};
+    while (hal.now() < duration) {
+        for (; eventIterator != events.end() && eventIterator->timestamp <= hal.now(); ++eventIterator) {
+            switch (eventIterator->type) {
+                case Event::Type::rising: {
+                    firmware.edge(eventIterator->payload, true);
+                    break;
+                }
+                case Event::Type::falling: {
+                    firmware.edge(eventIterator->payload, false);
+                    break;
+                }
+                case Event::Type::byte: {
+                    hal.receive(eventIterator->payload);
+                    break;
+                }
+            }
+        }
+        if (hal.now() == baseControlStart) {
+            control.store(Control::base, std::memory_order_release);
+        }
+        if (hal.now() % loopPeriod == 0) {
+            firmware.loop();
+            for (; decodedBytes + 3 <= hal.sent().size(); decodedBytes += 3) {
+                const auto index = static_cast<uint8_t>(hal.sent()[decodedBytes] >> 2);
+                const auto value = static_cast<uint16_t>(hal.sent()[decodedBytes + 1] >> 2) | (static_cast<uint16_t>(hal.sent()[decodedBytes + 2] & 0xfc) << 4);
+                const auto previousControl = control.load(std::memory_order_acquire);
+                try {
+                    radioMonitor.handle(index, value, std::chrono::steady_clock::time_point(std::chrono::microseconds(hal.now())));
+                } catch (const std::runtime_error&) {
+                    radioMonitor.lose();
+                }
+                if (control.load(std::memory_order_acquire) != previousControl) {
+                    transitions.push_back(Transition{hal.now(), control.load(std::memory_order_acquire)});
+                }
+            }
+        }
+        hal.advance(step);
+    }
+
+    // measure each command's latency from the reception of its frame's first byte (the setup commands are skipped)
+    uint64_t latenciesSum = 0;
+    uint64_t maximumLatency = 0;
+    std::size_t latenciesCount = 0;
+    for (; latenciesCount < framesStarts.size() && 4 + latenciesCount < hal.commands().size(); ++latenciesCount) {
+        const auto latency = hal.commands()[4 + latenciesCount].timestamp - framesStarts[latenciesCount];
+        latenciesSum += latency;
+        maximumLatency = std::max(maximumLatency, latency);
+    }
+    const auto& statistics = firmware.statistics();
+    const auto bytesPerSecond = static_cast<double>(hal.sent().size()) / (static_cast<double>(duration) / 1e6);
+    std::cout
+        << "upstream bytes: " << hal.sent().size() << " (" << bytesPerSecond << " B/s, " << (100 * bytesPerSecond / linkCapacity) << " % of the link)\n"
+        << "samples sent: " << statistics.samplesSent << ", suppressed: " << statistics.samplesSuppressed << "\n"
+        << "downstream bytes: " << statistics.bytesRead << ", commands applied: " << statistics.commandsApplied << ", frames discarded: " << statistics.framesDiscarded << "\n"
+        << "command-to-pulse latency: mean " << (latenciesCount == 0 ? 0 : latenciesSum / latenciesCount) << " us, max " << maximumLatency << " us\n"
+        << "failsafes: " << statistics.failsafes << std::endl;
+    auto transitionsMatch = transitions.size() == sizeof(expectedTransitions) / sizeof(expectedTransitions[0]);
+    for (std::size_t index = 0; index < transitions.size(); ++index) {
+        std::cout << "control " << (transitions[index].control == Control::base ? "base" : (transitions[index].control == Control::radio ? "radio" : "lost"));
+        if (index < sizeof(expectedTransitions) / sizeof(expectedTransitions[0])) {
+            const auto& expected = expectedTransitions[index];
+            std::cout << " after " << (transitions[index].timestamp - expected[0].timestamp) << " us (maximum " << (expected[1].timestamp - expected[0].timestamp) << " us)";
+            transitionsMatch = (
+                transitionsMatch
+                && transitions[index].control == expected[0].control
+                && transitions[index].timestamp >= expected[0].timestamp
+                && transitions[index].timestamp <= expected[1].timestamp
+            );
+        } else {
+            std::cout << " at " << transitions[index].timestamp << " us (unexpected)";
+        }
+        std::cout << "\n";
+    }
+    std::cout.flush();
+    if (
+        statistics.commandsApplied != framesStarts.size()
+        || latenciesCount != framesStarts.size()
+        || statistics.failsafes != 1
+        || maximumLatency > maximumLatencyBound
+        || !transitionsMatch
+        || statistics.samplesSent > maximumSamplesSent
+        || hal.sent().size() > 3 * maximumSamplesSent
+        || statistics.samplesSuppressed == 0
+    ) {
+        std::cerr << "unexpected firmware behavior" << std::endl;
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
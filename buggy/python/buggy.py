@@ -1,5 +1,10 @@
 """
 buggy provides tools to customize the buggy's behavior.
+
+Each process sending commands must call setSource first, with its own source identifier.
+The arbiter gives each source its own rate limits, and looks up its priority in sourcesConfigurations (arbiter.cpp).
+Identifiers 0 (path planner) and 1 (obstacle-avoidance reflex) are reserved,
+other scripts must pick distinct identifiers in the range [2, 255], which get the default configuration.
 """
 import socket
 import threading
@@ -7,6 +12,7 @@ import threading
 inputSocket = socket.socket(socket.AF_UNIX, socket.SOCK_STREAM)
 inputSocket.connect('/var/run/rotifera/arbiter.sock')
 outputFifo = open('/var/run/rotifera/arbiter.fifo', 'wb')
+source = None
 
 messageListeners = []
 messageListenersLock = threading.Lock()
@@ -68,6 +74,35 @@ def addMessageListener(messageListener):
     messageListeners.append(messageListener)
     messageListenersLock.release()
 
+def setSource(newSource):
+    """
+    setSource changes the identifier attached to the commands sent by this process.
+    The arbiter uses it to look up the source's priority, rate limit and lease.
+    It must be called before any command is sent.
+
+    Arguments:
+        newSource (integer): the source identifier, must be in the range [0, 255].
+    """
+    global source
+    if not isinstance(newSource, (int, long)):
+        raise AssertionError('source must be an integer')
+    if newSource < 0 or newSource > 255:
+        raise AssertionError('source must be in the range [0, 255]')
+    source = newSource
+
+def writeCommand(index, value):
+    """
+    writeCommand sends a motor command to the arbiter.
+
+    Arguments:
+        index (integer): the motor index.
+        value (integer): the motor command, in microseconds.
+    """
+    if source is None:
+        raise AssertionError('setSource must be called before sending commands')
+    outputFifo.write(bytearray((source, index, value & 0xff, (value >> 8) & 0xff)))
+    outputFifo.flush()
+
 def setDirection(direction):
     """
     setDirection changes the buggy's wheels direction.
@@ -80,8 +115,7 @@ def setDirection(direction):
     if direction < -500 or direction > 500:
         raise AssertionError('direction must be in the range [-500, 500]')
     correctedDirection = direction + 1500
-    outputFifo.write(bytearray((0, correctedDirection & 0xff, (correctedDirection >> 8) & 0xff)))
-    outputFifo.flush()
+    writeCommand(0, correctedDirection)
 
 def setSpeed(speed):
     """
@@ -95,8 +129,7 @@ def setSpeed(speed):
     if speed < -500 or speed > 500:
         raise AssertionError('speed must be in the range [-500, 500]')
     correctedSpeed = speed + 1500
-    outputFifo.write(bytearray((1, correctedSpeed & 0xff, (correctedSpeed >> 8) & 0xff)))
-    outputFifo.flush()
+    writeCommand(1, correctedSpeed)
 
 def setPan(pan):
     """
@@ -110,8 +143,7 @@ def setPan(pan):
     if pan < -500 or pan > 500:
         raise AssertionError('pan must be in the range [-500, 500]')
     correctedPan = pan + 1500
-    outputFifo.write(bytearray((2, correctedPan & 0xff, (correctedPan >> 8) & 0xff)))
-    outputFifo.flush()
+    writeCommand(2, correctedPan)
 
 def setTilt(tilt):
     """
@@ -125,5 +157,4 @@ def setTilt(tilt):
     if tilt < -500 or tilt > 500:
         raise AssertionError('tilt must be in the range [-500, 500]')
     correctedTilt = tilt + 1500
-    outputFifo.write(bytearray((3, correctedTilt & 0xff, (correctedTilt >> 8) & 0xff)))
-    outputFifo.flush()
+    writeCommand(3, correctedTilt)